@@ -0,0 +1,265 @@
+/*
+ * (C) 2024 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <bedrock/ComponentGraph.hpp>
+#include <bedrock/ModuleManager.hpp>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <functional>
+#include <unordered_map>
+
+using namespace bedrock;
+using nlohmann::json;
+
+/**
+ * Measures two things for a graph of N components:
+ *
+ * 1. Encoding: time to save and reload a ComponentGraph with its binary
+ *    encoding versus a JSON encoding of the same data (built, dumped,
+ *    parsed and converted back with nlohmann::json).
+ *
+ * 2. Restart: time to instantiate all the components again, from a
+ *    Bedrock-style JSON configuration (parse, ModuleManager::getDependencies,
+ *    resolve each dependency name, createComponent) versus from the binary
+ *    snapshot (FromBinary, ComponentDescriptor::toArgs, createComponent).
+ *    Components come from dummy modules registered with
+ *    ModuleManager::registerModule, so the numbers measure the cost of
+ *    the restart path itself, not of the modules. Dependencies are pools
+ *    and local providers; provider handles are left out since both paths
+ *    need the same address lookups for them. Resolution in the JSON path
+ *    is a plain name lookup, simpler than Bedrock's dependency specification
+ *    parsing, so its cost is a lower bound.
+ *
+ * Usage: bedrock-component-graph-benchmark [num_components] [repetitions]
+ */
+
+static ComponentGraph makeGraph(size_t num_components, bool with_handles) {
+    ComponentGraph graph;
+    graph.components.reserve(num_components);
+    for(size_t i = 0; i < num_components; ++i) {
+        ComponentDescriptor c;
+        c.name        = "component_" + std::to_string(i);
+        c.type        = i % 2 ? "bench_b" : "bench_a";
+        c.provider_id = static_cast<uint16_t>(i);
+        c.tags        = {"tag_a", "tag_b"};
+        c.config      = R"({"path":"/tmp/data","size":1024,"enabled":true})";
+        c.dependencies["pool"] = {
+            {"pool_" + std::to_string(i % 8), "pool", DependencyKind::Pool, 0, false, ""}};
+        if(i > 0) {
+            c.dependencies["local"] = {
+                {"component_" + std::to_string(i - 1), "bench",
+                 DependencyKind::LocalProvider, static_cast<uint16_t>(i - 1), false, ""}};
+        }
+        if(i > 0 && with_handles) {
+            c.dependencies["remote"] = {
+                {"component_" + std::to_string(i / 2), "bench",
+                 DependencyKind::ProviderHandle, static_cast<uint16_t>(i / 2),
+                 false, "na+sm://12345-0"}};
+        }
+        graph.components.push_back(std::move(c));
+    }
+    return graph;
+}
+
+static std::string toJSON(const ComponentGraph& graph) {
+    json result = json::object();
+    result["libraries"] = graph.libraries;
+    auto& components = result["components"] = json::array();
+    for(const auto& c : graph.components) {
+        json deps = json::object();
+        for(const auto& [dep_name, refs] : c.dependencies) {
+            auto& list = deps[dep_name] = json::array();
+            for(const auto& ref : refs)
+                list.push_back({
+                    {"name", ref.name}, {"type", ref.type},
+                    {"kind", static_cast<int>(ref.kind)},
+                    {"provider_id", ref.provider_id},
+                    {"is_self", ref.is_self},
+                    {"address", ref.address}});
+        }
+        components.push_back({
+            {"name", c.name}, {"type", c.type},
+            {"provider_id", c.provider_id}, {"tags", c.tags},
+            {"config", json::parse(c.config)},
+            {"dependencies", std::move(deps)}});
+    }
+    return result.dump();
+}
+
+static ComponentGraph fromJSON(const std::string& str) {
+    auto input = json::parse(str);
+    ComponentGraph graph;
+    graph.libraries = input["libraries"].get<std::vector<std::string>>();
+    for(const auto& c : input["components"]) {
+        ComponentDescriptor desc;
+        desc.name        = c["name"].get<std::string>();
+        desc.type        = c["type"].get<std::string>();
+        desc.provider_id = c["provider_id"].get<uint16_t>();
+        desc.tags        = c["tags"].get<std::vector<std::string>>();
+        desc.config      = c["config"].dump();
+        for(const auto& [dep_name, refs] : c["dependencies"].items()) {
+            auto& list = desc.dependencies[dep_name];
+            for(const auto& ref : refs)
+                list.push_back({
+                    ref["name"].get<std::string>(), ref["type"].get<std::string>(),
+                    static_cast<DependencyKind>(ref["kind"].get<int>()),
+                    ref["provider_id"].get<uint16_t>(),
+                    ref["is_self"].get<bool>(),
+                    ref["address"].get<std::string>()});
+        }
+        graph.components.push_back(std::move(desc));
+    }
+    return graph;
+}
+
+class BenchComponent : public AbstractComponent {
+
+    public:
+
+    static std::shared_ptr<AbstractComponent> Register(const ComponentArgs& args) {
+        (void)args;
+        return std::make_shared<BenchComponent>();
+    }
+
+    static std::vector<Dependency> GetDependencies(const ComponentArgs& args) {
+        (void)args;
+        return {
+            { "pool", "pool", true, false, false },
+            { "local", "bench", false, false, false }
+        };
+    }
+
+    void* getHandle() override {
+        return static_cast<void*>(this);
+    }
+};
+
+using PoolMap      = std::unordered_map<std::string, thallium::pool>;
+using ComponentMap = std::unordered_map<std::string, std::pair<ComponentPtr, uint16_t>>;
+
+/**
+ * Bedrock-style configuration: dependencies are given by name.
+ */
+static std::string toConfig(const ComponentGraph& graph) {
+    json providers = json::array();
+    for(const auto& c : graph.components) {
+        json deps = json::object();
+        for(const auto& [dep_name, refs] : c.dependencies)
+            deps[dep_name] = refs[0].name;
+        providers.push_back({
+            {"name", c.name}, {"type", c.type},
+            {"provider_id", c.provider_id}, {"tags", c.tags},
+            {"config", json::parse(c.config)},
+            {"dependencies", std::move(deps)}});
+    }
+    return json{{"libraries", graph.libraries}, {"providers", providers}}.dump();
+}
+
+static size_t restartFromConfig(const std::string& config, const PoolMap& pools) {
+    ComponentMap components;
+    auto input = json::parse(config);
+    for(const auto& p : input["providers"]) {
+        ComponentArgs args;
+        args.name        = p["name"].get<std::string>();
+        args.provider_id = p["provider_id"].get<uint16_t>();
+        args.tags        = p["tags"].get<std::vector<std::string>>();
+        args.config      = p["config"].dump();
+        auto type = p["type"].get<std::string>();
+        const auto& specs = p["dependencies"];
+        for(const auto& dep : ModuleManager::getDependencies(type, args)) {
+            auto it = specs.find(dep.name);
+            if(it == specs.end()) {
+                if(dep.is_required)
+                    throw Exception{"Missing dependency {} for {}", dep.name, args.name};
+                continue;
+            }
+            auto name = it->get<std::string>();
+            auto& list = args.dependencies[dep.name];
+            if(dep.type == "pool") {
+                list.push_back(std::make_shared<NamedDependency>(
+                    name, dep.type, pools.at(name)));
+            } else {
+                const auto& [component, provider_id] = components.at(name);
+                list.push_back(std::make_shared<ProviderDependency>(
+                    name, dep.type, component, provider_id));
+            }
+        }
+        components[args.name] = {ModuleManager::createComponent(type, args), args.provider_id};
+    }
+    return components.size();
+}
+
+static size_t restartFromBinary(const std::string& data, const PoolMap& pools) {
+    ComponentMap components;
+    auto graph = ComponentGraph::FromBinary(data);
+    DependencyResolver resolver;
+    resolver.pool = [&pools](const DependencyReference& ref) {
+        return pools.at(ref.name);
+    };
+    resolver.local_provider = [&components](const DependencyReference& ref) {
+        return components.at(ref.name).first;
+    };
+    for(const auto& desc : graph.components) {
+        auto args = desc.toArgs(thallium::engine{}, resolver);
+        components[desc.name] = {ModuleManager::createComponent(desc.type, args), desc.provider_id};
+    }
+    return components.size();
+}
+
+static double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+static double timeMs(const std::function<void()>& fn) {
+    auto t0 = std::chrono::steady_clock::now();
+    fn();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+int main(int argc, char** argv) {
+    size_t num_components = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5000;
+    size_t repetitions    = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10;
+    if(repetitions == 0) repetitions = 1;
+
+    // encoding
+    auto graph = makeGraph(num_components, true);
+    std::string binary, text;
+    std::vector<double> bin_save, bin_load, json_save, json_load;
+    for(size_t i = 0; i < repetitions; ++i) {
+        bin_save.push_back(timeMs([&]() { binary = graph.toBinary(); }));
+        bin_load.push_back(timeMs([&]() { ComponentGraph::FromBinary(binary); }));
+        json_save.push_back(timeMs([&]() { text = toJSON(graph); }));
+        json_load.push_back(timeMs([&]() { fromJSON(text); }));
+    }
+
+    // restart
+    ModuleManager::registerModule("bench_a", &BenchComponent::Register, &BenchComponent::GetDependencies);
+    ModuleManager::registerModule("bench_b", &BenchComponent::Register, &BenchComponent::GetDependencies);
+    PoolMap pools;
+    for(int i = 0; i < 8; ++i) pools["pool_" + std::to_string(i)] = thallium::pool{};
+    auto restart_graph  = makeGraph(num_components, false);
+    auto restart_binary = restart_graph.toBinary();
+    auto restart_config = toConfig(restart_graph);
+    std::vector<double> restart_json, restart_bin;
+    for(size_t i = 0; i < repetitions; ++i) {
+        restart_json.push_back(timeMs([&]() { restartFromConfig(restart_config, pools); }));
+        restart_bin.push_back(timeMs([&]() { restartFromBinary(restart_binary, pools); }));
+    }
+
+    std::cout << "components: " << num_components
+              << ", repetitions: " << repetitions << " (median times)\n"
+              << "encoding, binary: " << binary.size() << " bytes, save "
+              << median(bin_save) << " ms, load " << median(bin_load) << " ms\n"
+              << "encoding, json:   " << text.size() << " bytes, save "
+              << median(json_save) << " ms, load " << median(json_load) << " ms\n"
+              << "restart, from json config: " << median(restart_json) << " ms\n"
+              << "restart, from binary:      " << median(restart_bin) << " ms\n";
+    return 0;
+}
@@ -0,0 +1,301 @@
+/*
+ * (C) 2024 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <bedrock/AbstractComponent.hpp>
+#include <thallium.hpp>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+namespace tl = thallium;
+using nlohmann::json;
+
+/**
+ * @brief Workload options, read from the component's configuration:
+ * - rpc: "echo" (payload sent and sent back) or "bulk" (payload pulled by the sink);
+ * - iterations: total number of timed operations;
+ * - warmup: number of untimed operations issued before the timed ones;
+ * - payload_size: size of the payload in bytes;
+ * - concurrency: number of ULTs issuing operations in the component's pool;
+ * - timeout_ms: timeout of each operation in milliseconds, after which the
+ *   operation is counted as a failure. This also bounds how long the
+ *   component's destruction can wait for in-flight operations.
+ */
+struct LoadgenOptions {
+    std::string rpc          = "echo";
+    size_t      iterations   = 1000;
+    size_t      warmup       = 10;
+    size_t      payload_size = 64;
+    size_t      concurrency  = 1;
+    size_t      timeout_ms   = 10000;
+};
+
+/**
+ * @brief Component driving a workload against one or more loadgen_sink
+ * providers and reporting throughput and latency percentiles.
+ * The workload runs in the component's pool, using the provider handles
+ * from its "sinks" dependency in a round-robin manner.
+ *
+ * Results are logged and added to getConfig() under "results":
+ * - operations, failures, stopped (interrupted by destruction),
+ *   elapsed_sec, ops_per_sec;
+ * - mib_per_sec: payload bytes moved per second, in MiB/s, counting
+ *   both directions for echo (request and response) and the single
+ *   transfer for bulk;
+ * - latency_us: min, avg, p50, p90, p99 and max latency in microseconds.
+ */
+class LoadgenComponent : public bedrock::AbstractComponent {
+
+    tl::engine                       m_engine;
+    tl::pool                         m_pool;
+    std::vector<tl::provider_handle> m_sinks;
+    LoadgenOptions                   m_options;
+    json                             m_config;
+    tl::remote_procedure             m_echo;
+    tl::remote_procedure             m_bulk;
+    std::atomic<bool>                m_stop{false};
+    tl::eventual<void>               m_done;
+    tl::mutex                        m_results_mtx;
+    json                             m_results;
+
+    using clock = std::chrono::steady_clock;
+
+    tl::bulk exposePayload(std::string& payload) {
+        if(m_options.rpc != "bulk") return tl::bulk{};
+        std::vector<std::pair<void*, size_t>> segments = {
+            {payload.data(), payload.size()}};
+        return m_engine.expose(segments, tl::bulk_mode::read_only);
+    }
+
+    bool runOperation(const tl::provider_handle& sink,
+                      const std::string& payload,
+                      const tl::bulk& local) {
+        auto timeout = std::chrono::milliseconds(m_options.timeout_ms);
+        if(m_options.rpc == "echo") {
+            std::string response = m_echo.on(sink).timed(timeout, payload);
+            return response.size() == payload.size();
+        } else {
+            int32_t ret = m_bulk.on(sink).timed(timeout, local);
+            return ret == 0;
+        }
+    }
+
+    void runWorker(size_t worker_index, size_t num_ops,
+                   std::vector<double>& latencies, size_t& failures) {
+        std::string payload(m_options.payload_size, 'x');
+        tl::bulk local;
+        try {
+            local = exposePayload(payload);
+        } catch(const tl::exception& ex) {
+            spdlog::error("[loadgen] Could not expose payload: {}", ex.what());
+            failures += num_ops;
+            return;
+        }
+        latencies.reserve(num_ops);
+        for(size_t i = 0; i < num_ops && !m_stop; ++i) {
+            auto& sink = m_sinks[(worker_index + i) % m_sinks.size()];
+            auto t0 = clock::now();
+            bool success = false;
+            try {
+                success = runOperation(sink, payload, local);
+            } catch(const tl::exception& ex) {
+                spdlog::error("[loadgen] Operation failed: {}", ex.what());
+            }
+            auto t1 = clock::now();
+            if(!success) {
+                failures += 1;
+                continue;
+            }
+            latencies.push_back(
+                std::chrono::duration<double, std::micro>(t1 - t0).count());
+        }
+    }
+
+    void run() {
+        std::string payload(m_options.payload_size, 'x');
+        auto local = exposePayload(payload);
+        for(size_t i = 0; i < m_options.warmup && !m_stop; ++i) {
+            try {
+                if(!runOperation(m_sinks[i % m_sinks.size()], payload, local))
+                    spdlog::error("[loadgen] Warmup operation {} failed", i);
+            } catch(const tl::exception& ex) {
+                spdlog::error("[loadgen] Warmup operation {} failed: {}", i, ex.what());
+            }
+        }
+
+        auto n = m_options.concurrency;
+        std::vector<std::vector<double>> latencies(n);
+        std::vector<size_t> failures(n, 0);
+        std::vector<tl::managed<tl::thread>> workers;
+        workers.reserve(n);
+        auto t0 = clock::now();
+        try {
+            for(size_t w = 0; w < n; ++w) {
+                size_t num_ops = m_options.iterations / n
+                               + (w < m_options.iterations % n ? 1 : 0);
+                workers.push_back(m_pool.make_thread(
+                    [this, w, num_ops, &latencies, &failures]() {
+                        runWorker(w, num_ops, latencies[w], failures[w]);
+                    }));
+            }
+        } catch(const tl::exception&) {
+            m_stop = true;
+            for(auto& worker : workers) worker->join();
+            throw;
+        }
+        for(auto& worker : workers) worker->join();
+        auto t1 = clock::now();
+
+        std::vector<double> all;
+        all.reserve(m_options.iterations);
+        for(auto& l : latencies) all.insert(all.end(), l.begin(), l.end());
+        std::sort(all.begin(), all.end());
+        size_t num_failures = 0;
+        for(auto f : failures) num_failures += f;
+
+        auto percentile = [&all](double p) -> double {
+            if(all.empty()) return 0.0;
+            auto rank = static_cast<size_t>(std::ceil(p * all.size()));
+            return all[std::min(std::max<size_t>(rank, 1), all.size()) - 1];
+        };
+        double elapsed = std::chrono::duration<double>(t1 - t0).count();
+        double sum = 0.0;
+        for(auto l : all) sum += l;
+        size_t bytes_per_op = m_options.payload_size * (m_options.rpc == "echo" ? 2 : 1);
+
+        json results = json::object();
+        results["rpc"]          = m_options.rpc;
+        results["operations"]   = all.size();
+        results["failures"]     = num_failures;
+        results["stopped"]      = m_stop.load();
+        results["elapsed_sec"]  = elapsed;
+        results["ops_per_sec"]  = elapsed > 0 ? all.size() / elapsed : 0.0;
+        results["mib_per_sec"]  = elapsed > 0
+            ? (all.size() * bytes_per_op) / (elapsed * 1024.0 * 1024.0) : 0.0;
+        results["latency_us"] = {
+            {"min", all.empty() ? 0.0 : all.front()},
+            {"avg", all.empty() ? 0.0 : sum / all.size()},
+            {"p50", percentile(0.50)},
+            {"p90", percentile(0.90)},
+            {"p99", percentile(0.99)},
+            {"max", all.empty() ? 0.0 : all.back()}
+        };
+        spdlog::info("[loadgen] Results: {}", results.dump());
+        {
+            std::lock_guard<tl::mutex> lock{m_results_mtx};
+            m_results = std::move(results);
+        }
+    }
+
+    static size_t getSizeOption(const json& config, const char* name, size_t default_value) {
+        if(!config.contains(name)) return default_value;
+        const auto& value = config[name];
+        if(!value.is_number_unsigned())
+            throw bedrock::Exception{
+                "\"{}\" in loadgen configuration should be a non-negative integer", name};
+        return value.get<size_t>();
+    }
+
+    public:
+
+    LoadgenComponent(const tl::engine& engine,
+                     const tl::pool& pool,
+                     std::vector<tl::provider_handle> sinks,
+                     LoadgenOptions options,
+                     json config)
+    : m_engine(engine)
+    , m_pool(pool)
+    , m_sinks(std::move(sinks))
+    , m_options(std::move(options))
+    , m_config(std::move(config))
+    , m_echo(m_engine.define("loadgen_echo"))
+    , m_bulk(m_engine.define("loadgen_bulk")) {
+        m_pool.make_thread([this]() {
+            try {
+                run();
+            } catch(const std::exception& ex) {
+                spdlog::error("[loadgen] Workload failed: {}", ex.what());
+            } catch(...) {
+                spdlog::error("[loadgen] Workload failed with an unknown exception");
+            }
+            m_done.set_value();
+        }, tl::anonymous());
+    }
+
+    ~LoadgenComponent() {
+        m_stop = true;
+        m_done.wait();
+    }
+
+    static std::shared_ptr<bedrock::AbstractComponent>
+        Register(const bedrock::ComponentArgs& args) {
+            json config;
+            try {
+                config = args.config.empty() ? json::object() : json::parse(args.config);
+            } catch(const json::parse_error& ex) {
+                throw bedrock::Exception{
+                    "Could not parse loadgen configuration: {}", ex.what()};
+            }
+            if(!config.is_object())
+                throw bedrock::Exception{"loadgen configuration should be an object"};
+            LoadgenOptions options;
+            if(config.contains("rpc")) {
+                if(!config["rpc"].is_string())
+                    throw bedrock::Exception{"\"rpc\" in loadgen configuration should be a string"};
+                options.rpc = config["rpc"].get<std::string>();
+            }
+            options.iterations   = getSizeOption(config, "iterations", options.iterations);
+            options.warmup       = getSizeOption(config, "warmup", options.warmup);
+            options.payload_size = getSizeOption(config, "payload_size", options.payload_size);
+            options.concurrency  = getSizeOption(config, "concurrency", options.concurrency);
+            options.timeout_ms   = getSizeOption(config, "timeout_ms", options.timeout_ms);
+            if(options.rpc != "echo" && options.rpc != "bulk")
+                throw bedrock::Exception{
+                    "Invalid \"rpc\" value \"{}\" in loadgen configuration "
+                    "(expected \"echo\" or \"bulk\")", options.rpc};
+            if(options.concurrency == 0)
+                throw bedrock::Exception{"\"concurrency\" should be at least 1"};
+            if(options.timeout_ms == 0)
+                throw bedrock::Exception{"\"timeout_ms\" should be at least 1"};
+            if(options.rpc == "bulk" && options.payload_size == 0)
+                throw bedrock::Exception{"\"payload_size\" should be at least 1 for bulk"};
+
+            auto pool_it = args.dependencies.find("pool");
+            auto pool = pool_it->second[0]->getHandle<tl::pool>();
+            std::vector<tl::provider_handle> sinks;
+            for(auto& s : args.dependencies.find("sinks")->second)
+                sinks.push_back(s->getHandle<tl::provider_handle>());
+
+            return std::make_shared<LoadgenComponent>(
+                args.engine, pool, std::move(sinks), std::move(options), std::move(config));
+    }
+
+    static std::vector<bedrock::Dependency>
+        GetDependencies(const bedrock::ComponentArgs& args) {
+        (void)args;
+        std::vector<bedrock::Dependency> deps = {
+            { "pool", "pool", true, false, false },
+            { "sinks", "loadgen_sink", true, true, false }
+        };
+        return deps;
+    }
+
+    std::string getConfig() override {
+        auto config = m_config;
+        std::lock_guard<tl::mutex> lock{m_results_mtx};
+        if(!m_results.is_null()) config["results"] = m_results;
+        return config.dump();
+    }
+
+    void* getHandle() override {
+        return static_cast<void*>(this);
+    }
+};
+
+BEDROCK_REGISTER_COMPONENT_TYPE(loadgen, LoadgenComponent)
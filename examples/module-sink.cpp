@@ -0,0 +1,213 @@
+/*
+ * (C) 2024 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <bedrock/AbstractComponent.hpp>
+#include <thallium.hpp>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+#include <vector>
+
+namespace tl = thallium;
+using nlohmann::json;
+
+static constexpr size_t s_max_total_buffer_size = 1024*1024*1024;
+
+/**
+ * @brief Options read from the component's configuration:
+ * - num_buffers: number of bulk buffers, i.e. maximum number of
+ *   loadgen_bulk transfers handled concurrently;
+ * - buffer_size: size of each buffer, i.e. maximum size of a transfer.
+ * The total (num_buffers * buffer_size) cannot exceed s_max_total_buffer_size.
+ */
+struct SinkOptions {
+    size_t num_buffers = 8;
+    size_t buffer_size = 1024*1024;
+};
+
+/**
+ * @brief Provider answering the RPCs issued by the loadgen module:
+ * - loadgen_echo sends its payload back;
+ * - loadgen_bulk pulls the content of the given bulk handle into one of
+ *   the provider's buffers and responds with 0, or -1 on failure.
+ *
+ * Buffers are allocated and registered once, when the provider is
+ * created, so that memory registration stays out of the measured path.
+ * Handlers are counted while they run, and the destructor waits for
+ * them to complete before the buffers are released.
+ */
+class SinkProvider : public tl::provider<SinkProvider> {
+
+    struct Buffer {
+        std::vector<char> data;
+        tl::bulk          bulk;
+    };
+
+    SinkOptions                       m_options;
+    std::vector<Buffer>               m_buffers;
+    std::vector<Buffer*>              m_free_buffers;
+    tl::mutex                         m_buffers_mtx;
+    tl::condition_variable            m_buffers_cv;
+    size_t                            m_num_handlers = 0;
+    tl::condition_variable            m_handlers_cv;
+    std::vector<tl::remote_procedure> m_rpcs;
+
+    struct HandlerGuard {
+
+        SinkProvider& m_provider;
+
+        HandlerGuard(SinkProvider& provider)
+        : m_provider(provider) {
+            std::lock_guard<tl::mutex> lock{m_provider.m_buffers_mtx};
+            m_provider.m_num_handlers += 1;
+        }
+
+        ~HandlerGuard() {
+            std::lock_guard<tl::mutex> lock{m_provider.m_buffers_mtx};
+            m_provider.m_num_handlers -= 1;
+            if(m_provider.m_num_handlers == 0)
+                m_provider.m_handlers_cv.notify_all();
+        }
+    };
+
+    Buffer* acquireBuffer() {
+        std::unique_lock<tl::mutex> lock{m_buffers_mtx};
+        m_buffers_cv.wait(lock, [this]() { return !m_free_buffers.empty(); });
+        auto buffer = m_free_buffers.back();
+        m_free_buffers.pop_back();
+        return buffer;
+    }
+
+    void releaseBuffer(Buffer* buffer) {
+        {
+            std::lock_guard<tl::mutex> lock{m_buffers_mtx};
+            m_free_buffers.push_back(buffer);
+        }
+        m_buffers_cv.notify_one();
+    }
+
+    void echo(const tl::request& req, const std::string& payload) {
+        HandlerGuard guard{*this};
+        req.respond(payload);
+    }
+
+    void bulk(const tl::request& req, const tl::bulk& remote) {
+        HandlerGuard guard{*this};
+        int32_t ret  = 0;
+        size_t  size = remote.size();
+        if(size == 0 || size > m_options.buffer_size) {
+            spdlog::error("[loadgen_sink] Invalid bulk size {} (buffer size is {})",
+                          size, m_options.buffer_size);
+            req.respond(static_cast<int32_t>(-1));
+            return;
+        }
+        auto buffer = acquireBuffer();
+        try {
+            remote.on(req.get_endpoint()) >> buffer->bulk.select(0, size);
+        } catch(const tl::exception& ex) {
+            spdlog::error("[loadgen_sink] Bulk transfer failed: {}", ex.what());
+            ret = -1;
+        }
+        releaseBuffer(buffer);
+        req.respond(ret);
+    }
+
+    public:
+
+    SinkProvider(const tl::engine& engine, uint16_t provider_id,
+                 const tl::pool& pool, const SinkOptions& options)
+    : tl::provider<SinkProvider>(engine, provider_id)
+    , m_options(options) {
+        m_buffers.resize(m_options.num_buffers);
+        m_free_buffers.reserve(m_buffers.size());
+        for(auto& buffer : m_buffers) {
+            buffer.data.resize(m_options.buffer_size);
+            std::vector<std::pair<void*, size_t>> segments = {
+                {buffer.data.data(), buffer.data.size()}};
+            buffer.bulk = get_engine().expose(segments, tl::bulk_mode::write_only);
+            m_free_buffers.push_back(&buffer);
+        }
+        m_rpcs.push_back(define("loadgen_echo", &SinkProvider::echo, pool));
+        m_rpcs.push_back(define("loadgen_bulk", &SinkProvider::bulk, pool));
+    }
+
+    ~SinkProvider() {
+        for(auto& rpc : m_rpcs) rpc.deregister();
+        std::unique_lock<tl::mutex> lock{m_buffers_mtx};
+        m_handlers_cv.wait(lock, [this]() { return m_num_handlers == 0; });
+    }
+};
+
+static size_t getSizeOption(const json& config, const char* name, size_t default_value) {
+    if(!config.contains(name)) return default_value;
+    const auto& value = config[name];
+    if(!value.is_number_unsigned() || value.get<size_t>() == 0)
+        throw bedrock::Exception{
+            "\"{}\" in loadgen_sink configuration should be a positive integer", name};
+    return value.get<size_t>();
+}
+
+class SinkComponent : public bedrock::AbstractComponent {
+
+    std::unique_ptr<SinkProvider> m_provider;
+
+    public:
+
+    SinkComponent(const tl::engine& engine, uint16_t provider_id,
+                  const tl::pool& pool, const SinkOptions& options)
+    : m_provider{new SinkProvider{engine, provider_id, pool, options}} {}
+
+    static std::shared_ptr<bedrock::AbstractComponent>
+        Register(const bedrock::ComponentArgs& args) {
+            json config;
+            try {
+                config = args.config.empty() ? json::object() : json::parse(args.config);
+            } catch(const json::parse_error& ex) {
+                throw bedrock::Exception{
+                    "Could not parse loadgen_sink configuration: {}", ex.what()};
+            }
+            if(!config.is_object())
+                throw bedrock::Exception{"loadgen_sink configuration should be an object"};
+            SinkOptions options;
+            options.num_buffers = getSizeOption(config, "num_buffers", options.num_buffers);
+            options.buffer_size = getSizeOption(config, "buffer_size", options.buffer_size);
+            if(options.buffer_size > s_max_total_buffer_size / options.num_buffers)
+                throw bedrock::Exception{
+                    "\"num_buffers\" ({}) * \"buffer_size\" ({}) in loadgen_sink "
+                    "configuration exceeds the maximum of {} bytes",
+                    options.num_buffers, options.buffer_size, s_max_total_buffer_size};
+
+            auto pool_it = args.dependencies.find("pool");
+            auto pool = pool_it->second[0]->getHandle<tl::pool>();
+            try {
+                return std::make_shared<SinkComponent>(
+                    args.engine, args.provider_id, pool, options);
+            } catch(const std::bad_alloc&) {
+                throw bedrock::Exception{
+                    "Could not allocate {} buffers of {} bytes (\"num_buffers\" "
+                    "and \"buffer_size\" in loadgen_sink configuration)",
+                    options.num_buffers, options.buffer_size};
+            } catch(const tl::exception& ex) {
+                throw bedrock::Exception{
+                    "Could not register {} buffers of {} bytes (\"num_buffers\" "
+                    "and \"buffer_size\" in loadgen_sink configuration): {}",
+                    options.num_buffers, options.buffer_size, ex.what()};
+            }
+    }
+
+    static std::vector<bedrock::Dependency>
+        GetDependencies(const bedrock::ComponentArgs& args) {
+        (void)args;
+        std::vector<bedrock::Dependency> deps = {
+            { "pool", "pool", true, false, false }
+        };
+        return deps;
+    }
+
+    void* getHandle() override {
+        return static_cast<void*>(m_provider.get());
+    }
+};
+
+BEDROCK_REGISTER_COMPONENT_TYPE(loadgen_sink, SinkComponent)
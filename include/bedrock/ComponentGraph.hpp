@@ -0,0 +1,156 @@
+/*
+ * (C) 2024 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __BEDROCK_COMPONENT_GRAPH_HPP
+#define __BEDROCK_COMPONENT_GRAPH_HPP
+
+#include <bedrock/AbstractComponent.hpp>
+#include <thallium.hpp>
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <cstdint>
+
+namespace bedrock {
+
+/**
+ * @brief Kind of handle held by a resolved dependency.
+ */
+enum class DependencyKind : uint8_t {
+    Pool           = 0, // thallium::pool
+    XStream        = 1, // thallium::xstream
+    LocalProvider  = 2, // ComponentPtr to a component in the same process
+    ProviderHandle = 3  // thallium::provider_handle
+};
+
+/**
+ * @brief The DependencyReference structure records a dependency that
+ * has been resolved for a component, by name and location rather than
+ * by handle.
+ *
+ * - name: name of the resolved dependency (e.g. pool or component name).
+ * - type: type of the resolved dependency.
+ * - kind: kind of handle the dependency was resolved to.
+ * - provider_id: provider id (LocalProvider and ProviderHandle only).
+ * - is_self: whether the provider handle pointed to the process' own
+ *            address (ProviderHandle only). Such handles are rebound to
+ *            the new self address on restart, since self addresses
+ *            (e.g. na+sm PIDs, dynamic ports) change across restarts.
+ * - address: address of the provider (ProviderHandle only, empty if is_self).
+ */
+struct DependencyReference {
+    std::string    name;
+    std::string    type;
+    DependencyKind kind        = DependencyKind::Pool;
+    uint16_t       provider_id = 0;
+    bool           is_self     = false;
+    std::string    address;
+};
+
+/**
+ * @brief The DependencyResolver structure provides the functions used by
+ * ComponentDescriptor::toArgs to rebuild the handles that are known by name
+ * only (pools, xstreams and local providers). Provider handles are rebuilt
+ * from their address and provider id and do not need a resolver function.
+ *
+ * Functions may throw a bedrock::Exception if the name cannot be found.
+ */
+struct DependencyResolver {
+    std::function<thallium::pool(const DependencyReference&)>    pool;
+    std::function<thallium::xstream(const DependencyReference&)> xstream;
+    std::function<ComponentPtr(const DependencyReference&)>      local_provider;
+};
+
+/**
+ * @brief The ComponentDescriptor structure describes a component
+ * that has been instantiated, along with its resolved dependencies.
+ */
+struct ComponentDescriptor {
+    std::string              name;            // name of the component
+    std::string              type;            // module name
+    uint16_t                 provider_id = 0; // provider id
+    std::vector<std::string> tags;            // tags
+    std::string              config;          // JSON configuration
+    std::map<std::string, std::vector<DependencyReference>>
+                             dependencies;    // resolved dependencies
+
+    /**
+     * @brief Build a ComponentDescriptor from the ComponentArgs that
+     * were used to create a component of the specified type.
+     *
+     * This function throws a bedrock::Exception if one of the dependencies
+     * is null, holds a handle that is not one of the kinds listed in
+     * DependencyKind, or is a provider handle whose address cannot be
+     * obtained.
+     *
+     * @param type Module name.
+     * @param args Arguments (with resolved dependencies).
+     */
+    static ComponentDescriptor FromArgs(const std::string& type,
+                                        const ComponentArgs& args);
+
+    /**
+     * @brief Rebuild the ComponentArgs (including resolved dependencies)
+     * needed to create the component with ModuleManager::createComponent,
+     * without calling ModuleManager::getDependencies.
+     *
+     * Provider handles are looked up from their address, or from the
+     * engine's own address if is_self is set. Other dependencies are
+     * obtained from the resolver. This function throws a bedrock::Exception
+     * if a dependency cannot be rebuilt.
+     *
+     * @param engine Engine to set in the ComponentArgs.
+     * @param resolver Resolver for pools, xstreams and local providers.
+     */
+    ComponentArgs toArgs(const thallium::engine& engine,
+                         const DependencyResolver& resolver) const;
+};
+
+/**
+ * @brief The ComponentGraph structure describes the full set of libraries
+ * and components of a process, in a form that can be saved in a compact
+ * binary format and reloaded on restart.
+ *
+ * Components are expected to be listed in instantiation order, i.e.
+ * a component appears after all the components it depends on, so that
+ * a restart can load the libraries (ModuleManager::loadModulesFromGraph),
+ * then instantiate the components sequentially using
+ * ComponentDescriptor::toArgs and ModuleManager::createComponent, instead
+ * of calling getDependencies and resolving dependency specifications again.
+ *
+ * The binary encoding is deterministic: identical graphs produce
+ * identical bytes.
+ */
+struct ComponentGraph {
+    std::vector<std::string>         libraries;
+    std::vector<ComponentDescriptor> components;
+
+    /**
+     * @brief Serialize the graph into a binary string.
+     */
+    std::string toBinary() const;
+
+    /**
+     * @brief Deserialize a graph from a binary string produced by toBinary.
+     *
+     * This function throws a bedrock::Exception if the data is malformed.
+     *
+     * @param data Binary data.
+     * @param size Size of the data.
+     */
+    static ComponentGraph FromBinary(const char* data, size_t size);
+
+    /**
+     * @brief Same as above, taking an std::string.
+     */
+    static ComponentGraph FromBinary(const std::string& data) {
+        return FromBinary(data.data(), data.size());
+    }
+};
+
+} // namespace bedrock
+
+#endif
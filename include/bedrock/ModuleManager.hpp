@@ -17,6 +17,7 @@ namespace bedrock {
 class AbstractComponent;
 struct ComponentArgs;
 struct Dependency;
+struct ComponentGraph;
 
 /**
  * @brief The ModuleManager class contains functions to load modules.
@@ -64,11 +65,23 @@ class ModuleManager {
      */
     static void loadModulesFromJSON(const std::string& jsonString);
 
+    /**
+     * @brief Load the modules listed in a ComponentGraph.
+     *
+     * @param graph ComponentGraph (e.g. obtained from ComponentGraph::FromBinary).
+     */
+    static void loadModulesFromGraph(const ComponentGraph& graph);
+
     /**
      * @brief Return the current JSON configuration.
      */
     static std::string getCurrentConfig();
 
+    /**
+     * @brief Return the list of libraries loaded so far, in loading order.
+     */
+    static const std::vector<std::string>& getLoadedLibraries();
+
     /**
      * @brief Create a component from the designated module.
      */
@@ -11,6 +11,7 @@
 #include <memory>
 #include <functional>
 #include <any>
+#include <typeinfo>
 
 namespace bedrock {
 
@@ -50,6 +51,10 @@ class NamedDependency {
         return m_type;
     }
 
+    template<typename H> bool hasHandleOfType() const {
+        return m_handle.type() == typeid(H);
+    }
+
     template<typename H> H getHandle() const {
         try {
             return std::any_cast<H>(m_handle);
@@ -0,0 +1,301 @@
+/*
+ * (C) 2024 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <bedrock/ComponentGraph.hpp>
+#include <bedrock/AbstractComponent.hpp>
+#include <bedrock/DetailedException.hpp>
+#include <cstring>
+
+namespace bedrock {
+
+// Binary layout: magic, version, then length-prefixed fields.
+// Integers are written in host byte order, the snapshot is meant to be
+// reloaded on the same kind of machine that produced it.
+static constexpr char     s_graph_magic[8] = {'B','D','R','K','G','R','P','H'};
+static constexpr uint32_t s_graph_version  = 3;
+
+namespace {
+
+class BinaryWriter {
+
+    std::string& m_out;
+
+    public:
+
+    BinaryWriter(std::string& out)
+    : m_out(out) {}
+
+    template<typename T>
+    void write(const T& value) {
+        m_out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void write(const std::string& str) {
+        write(static_cast<uint64_t>(str.size()));
+        m_out.append(str);
+    }
+};
+
+class BinaryReader {
+
+    const char* m_data;
+    size_t      m_size;
+    size_t      m_pos = 0;
+
+    void ensure(size_t n) const {
+        if(n > m_size - m_pos)
+            throw BEDROCK_DETAILED_EXCEPTION(
+                "Truncated ComponentGraph data (offset {}, need {} bytes, size {})",
+                m_pos, n, m_size);
+    }
+
+    public:
+
+    BinaryReader(const char* data, size_t size)
+    : m_data(data), m_size(size) {}
+
+    template<typename T>
+    void read(T& value) {
+        ensure(sizeof(value));
+        std::memcpy(&value, m_data + m_pos, sizeof(value));
+        m_pos += sizeof(value);
+    }
+
+    void read(std::string& str) {
+        uint64_t size = 0;
+        read(size);
+        ensure(size);
+        str.assign(m_data + m_pos, size);
+        m_pos += size;
+    }
+
+    uint64_t readCount(size_t min_element_size) {
+        uint64_t count = 0;
+        read(count);
+        // reject counts that could not possibly fit in the remaining
+        // data, to avoid huge allocations on corrupted input
+        if(count > (m_size - m_pos) / min_element_size)
+            throw BEDROCK_DETAILED_EXCEPTION(
+                "Invalid element count {} in ComponentGraph data", count);
+        return count;
+    }
+
+    bool done() const {
+        return m_pos == m_size;
+    }
+};
+
+} // namespace
+
+ComponentDescriptor ComponentDescriptor::FromArgs(const std::string& type,
+                                                  const ComponentArgs& args) {
+    ComponentDescriptor desc;
+    desc.name        = args.name;
+    desc.type        = type;
+    desc.provider_id = args.provider_id;
+    desc.tags        = args.tags;
+    desc.config      = args.config;
+    std::string self_address; // looked up on first provider handle
+    for(const auto& [dep_name, dep_list] : args.dependencies) {
+        auto& refs = desc.dependencies[dep_name];
+        refs.reserve(dep_list.size());
+        for(const auto& dep : dep_list) {
+            if(!dep)
+                throw BEDROCK_DETAILED_EXCEPTION(
+                    "Cannot describe dependency \"{}\" of component \"{}\": "
+                    "null dependency", dep_name, args.name);
+            DependencyReference ref;
+            ref.name = dep->getName();
+            ref.type = dep->getType();
+            if(dep->hasHandleOfType<thallium::pool>()) {
+                ref.kind = DependencyKind::Pool;
+            } else if(dep->hasHandleOfType<thallium::xstream>()) {
+                ref.kind = DependencyKind::XStream;
+            } else if(dep->hasHandleOfType<ComponentPtr>()) {
+                ref.kind = DependencyKind::LocalProvider;
+                auto provider = dynamic_cast<const ProviderDependency*>(dep.get());
+                if(provider) ref.provider_id = provider->getProviderID();
+            } else if(dep->hasHandleOfType<thallium::provider_handle>()) {
+                auto ph = dep->getHandle<thallium::provider_handle>();
+                ref.kind        = DependencyKind::ProviderHandle;
+                ref.provider_id = ph.provider_id();
+                try {
+                    auto address = static_cast<std::string>(ph);
+                    if(self_address.empty())
+                        self_address = static_cast<std::string>(args.engine.self());
+                    if(address == self_address) ref.is_self = true;
+                    else ref.address = std::move(address);
+                } catch(const thallium::exception& ex) {
+                    throw BEDROCK_DETAILED_EXCEPTION(
+                        "Cannot describe dependency \"{}\" of component \"{}\": {}",
+                        ref.name, args.name, ex.what());
+                }
+            } else {
+                throw BEDROCK_DETAILED_EXCEPTION(
+                    "Cannot describe dependency \"{}\" of component \"{}\": "
+                    "unsupported handle type", ref.name, args.name);
+            }
+            refs.push_back(std::move(ref));
+        }
+    }
+    return desc;
+}
+
+ComponentArgs ComponentDescriptor::toArgs(const thallium::engine& engine,
+                                          const DependencyResolver& resolver) const {
+    ComponentArgs args;
+    args.name        = name;
+    args.engine      = engine;
+    args.provider_id = provider_id;
+    args.tags        = tags;
+    args.config      = config;
+    for(const auto& [dep_name, refs] : dependencies) {
+        auto& list = args.dependencies[dep_name];
+        list.reserve(refs.size());
+        for(const auto& ref : refs) {
+            auto missing = [&]() {
+                return BEDROCK_DETAILED_EXCEPTION(
+                    "Cannot rebuild dependency \"{}\" of component \"{}\": "
+                    "no resolver function for its kind", ref.name, name);
+            };
+            switch(ref.kind) {
+            case DependencyKind::Pool:
+                if(!resolver.pool) throw missing();
+                list.push_back(std::make_shared<NamedDependency>(
+                    ref.name, ref.type, resolver.pool(ref)));
+                break;
+            case DependencyKind::XStream:
+                if(!resolver.xstream) throw missing();
+                list.push_back(std::make_shared<NamedDependency>(
+                    ref.name, ref.type, resolver.xstream(ref)));
+                break;
+            case DependencyKind::LocalProvider: {
+                if(!resolver.local_provider) throw missing();
+                auto component = resolver.local_provider(ref);
+                if(!component)
+                    throw BEDROCK_DETAILED_EXCEPTION(
+                        "Cannot rebuild dependency \"{}\" of component \"{}\": "
+                        "local provider not found", ref.name, name);
+                list.push_back(std::make_shared<ProviderDependency>(
+                    ref.name, ref.type, std::move(component), ref.provider_id));
+                break;
+            }
+            case DependencyKind::ProviderHandle:
+                try {
+                    auto endpoint = ref.is_self ? engine.self() : engine.lookup(ref.address);
+                    list.push_back(std::make_shared<ProviderDependency>(
+                        ref.name, ref.type,
+                        thallium::provider_handle{endpoint, ref.provider_id},
+                        ref.provider_id));
+                } catch(const thallium::exception& ex) {
+                    throw BEDROCK_DETAILED_EXCEPTION(
+                        "Cannot rebuild dependency \"{}\" of component \"{}\": {}",
+                        ref.name, name, ex.what());
+                }
+                break;
+            }
+        }
+    }
+    return args;
+}
+
+std::string ComponentGraph::toBinary() const {
+    std::string result;
+    BinaryWriter writer{result};
+    result.append(s_graph_magic, sizeof(s_graph_magic));
+    writer.write(s_graph_version);
+    writer.write(static_cast<uint64_t>(libraries.size()));
+    for(const auto& lib : libraries) writer.write(lib);
+    writer.write(static_cast<uint64_t>(components.size()));
+    for(const auto& c : components) {
+        writer.write(c.name);
+        writer.write(c.type);
+        writer.write(c.provider_id);
+        writer.write(static_cast<uint64_t>(c.tags.size()));
+        for(const auto& t : c.tags) writer.write(t);
+        writer.write(c.config);
+        writer.write(static_cast<uint64_t>(c.dependencies.size()));
+        for(const auto& [dep_name, refs] : c.dependencies) {
+            writer.write(dep_name);
+            writer.write(static_cast<uint64_t>(refs.size()));
+            for(const auto& ref : refs) {
+                writer.write(ref.name);
+                writer.write(ref.type);
+                writer.write(static_cast<uint8_t>(ref.kind));
+                writer.write(ref.provider_id);
+                writer.write(static_cast<uint8_t>(ref.is_self));
+                writer.write(ref.address);
+            }
+        }
+    }
+    return result;
+}
+
+ComponentGraph ComponentGraph::FromBinary(const char* data, size_t size) {
+    if(size < sizeof(s_graph_magic)
+    || std::memcmp(data, s_graph_magic, sizeof(s_graph_magic)) != 0)
+        throw BEDROCK_DETAILED_EXCEPTION("Invalid ComponentGraph data (bad magic)");
+    BinaryReader reader{data + sizeof(s_graph_magic), size - sizeof(s_graph_magic)};
+    uint32_t version = 0;
+    reader.read(version);
+    if(version != s_graph_version)
+        throw BEDROCK_DETAILED_EXCEPTION(
+            "Unsupported ComponentGraph version {} (expected {})",
+            version, s_graph_version);
+
+    // smallest possible encodings, used to validate counts
+    constexpr size_t min_string_size     = sizeof(uint64_t);
+    constexpr size_t min_component_size  = 3*min_string_size + sizeof(uint16_t) + 2*sizeof(uint64_t);
+    constexpr size_t min_dependency_size = min_string_size + sizeof(uint64_t);
+    constexpr size_t min_reference_size  = 3*min_string_size + 2*sizeof(uint8_t) + sizeof(uint16_t);
+
+    ComponentGraph graph;
+    graph.libraries.resize(reader.readCount(min_string_size));
+    for(auto& lib : graph.libraries) reader.read(lib);
+    graph.components.resize(reader.readCount(min_component_size));
+    for(auto& c : graph.components) {
+        reader.read(c.name);
+        reader.read(c.type);
+        reader.read(c.provider_id);
+        c.tags.resize(reader.readCount(min_string_size));
+        for(auto& t : c.tags) reader.read(t);
+        reader.read(c.config);
+        auto num_deps = reader.readCount(min_dependency_size);
+        for(uint64_t i = 0; i < num_deps; ++i) {
+            std::string dep_name;
+            reader.read(dep_name);
+            auto [it, inserted] = c.dependencies.emplace(dep_name, std::vector<DependencyReference>{});
+            if(!inserted)
+                throw BEDROCK_DETAILED_EXCEPTION(
+                    "Duplicate dependency \"{}\" for component \"{}\" in ComponentGraph data",
+                    dep_name, c.name);
+            auto& refs = it->second;
+            refs.resize(reader.readCount(min_reference_size));
+            for(auto& ref : refs) {
+                reader.read(ref.name);
+                reader.read(ref.type);
+                uint8_t kind = 0;
+                reader.read(kind);
+                if(kind > static_cast<uint8_t>(DependencyKind::ProviderHandle))
+                    throw BEDROCK_DETAILED_EXCEPTION(
+                        "Invalid dependency kind {} in ComponentGraph data", kind);
+                ref.kind = static_cast<DependencyKind>(kind);
+                reader.read(ref.provider_id);
+                uint8_t is_self = 0;
+                reader.read(is_self);
+                if(is_self > 1)
+                    throw BEDROCK_DETAILED_EXCEPTION(
+                        "Invalid is_self flag {} in ComponentGraph data", is_self);
+                ref.is_self = is_self;
+                reader.read(ref.address);
+            }
+        }
+    }
+    if(!reader.done())
+        throw BEDROCK_DETAILED_EXCEPTION("Trailing bytes in ComponentGraph data");
+    return graph;
+}
+
+} // namespace bedrock
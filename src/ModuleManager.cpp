@@ -5,6 +5,7 @@
  */
 #include <bedrock/ModuleManager.hpp>
 #include <bedrock/AbstractComponent.hpp>
+#include <bedrock/ComponentGraph.hpp>
 #include <bedrock/DetailedException.hpp>
 #include <nlohmann/json.hpp>
 #include <spdlog/spdlog.h>
@@ -70,16 +71,16 @@ void ModuleManager::loadModulesFromJSON(const std::string& jsonString) {
     }
 }
 
+void ModuleManager::loadModulesFromGraph(const ComponentGraph& graph) {
+    for(auto& lib : graph.libraries) loadModule(lib);
+}
+
 std::string ModuleManager::getCurrentConfig() {
-    std::string config = "[";
-    unsigned    i      = 0;
-    for (const auto& m : s_loaded_libraries) {
-        config += "\"" + m + "\"";
-        i += 1;
-        if (i < s_loaded_libraries.size()) config += ",";
-    }
-    config += "]";
-    return config;
+    return json(s_loaded_libraries).dump();
+}
+
+const std::vector<std::string>& ModuleManager::getLoadedLibraries() {
+    return s_loaded_libraries;
 }
 
 std::shared_ptr<AbstractComponent> ModuleManager::createComponent(
@@ -0,0 +1,275 @@
+/*
+ * (C) 2024 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <bedrock/ComponentGraph.hpp>
+#include <bedrock/AbstractComponent.hpp>
+#include <cstring>
+#include <iostream>
+
+using namespace bedrock;
+
+static int s_failures = 0;
+
+#define CHECK(__cond) do { \
+    if(!(__cond)) { \
+        std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #__cond ") failed" << std::endl; \
+        s_failures += 1; \
+    } \
+} while(0)
+
+#define CHECK_THROWS(__expr) do { \
+    bool __thrown = false; \
+    try { __expr; } catch(const Exception&) { __thrown = true; } \
+    if(!__thrown) { \
+        std::cerr << __FILE__ << ":" << __LINE__ << ": " #__expr " did not throw" << std::endl; \
+        s_failures += 1; \
+    } \
+} while(0)
+
+namespace bedrock {
+
+static bool operator==(const DependencyReference& a, const DependencyReference& b) {
+    return a.name == b.name && a.type == b.type && a.kind == b.kind
+        && a.provider_id == b.provider_id && a.is_self == b.is_self
+        && a.address == b.address;
+}
+
+static bool operator==(const ComponentDescriptor& a, const ComponentDescriptor& b) {
+    return a.name == b.name && a.type == b.type && a.provider_id == b.provider_id
+        && a.tags == b.tags && a.config == b.config && a.dependencies == b.dependencies;
+}
+
+} // namespace bedrock
+
+static ComponentGraph makeGraph() {
+    ComponentGraph graph;
+    graph.libraries = {"liba.so", "libb.so"};
+    ComponentDescriptor a;
+    a.name        = "a";
+    a.type        = "module_a";
+    a.provider_id = 1;
+    a.tags        = {"x", "y"};
+    a.config      = "{\"k\":1}";
+    a.dependencies["pool"] = {{"__primary__", "pool", DependencyKind::Pool, 0, false, ""}};
+    ComponentDescriptor b;
+    b.name        = "b";
+    b.type        = "module_b";
+    b.provider_id = 2;
+    b.dependencies["pool"] = {{"my_pool", "pool", DependencyKind::Pool, 0, false, ""}};
+    b.dependencies["a_provider"] = {{"a", "module_a", DependencyKind::LocalProvider, 1, false, ""}};
+    b.dependencies["a_provider_handles"] = {
+        {"a", "module_a", DependencyKind::ProviderHandle, 1, true, ""},
+        {"c", "module_a", DependencyKind::ProviderHandle, 3, false, "na+sm://5678-0"}};
+    graph.components = {a, b, ComponentDescriptor{}};
+    return graph;
+}
+
+static void testRoundTrip() {
+    auto graph = makeGraph();
+    auto data  = graph.toBinary();
+    auto copy  = ComponentGraph::FromBinary(data);
+    CHECK(copy.libraries == graph.libraries);
+    CHECK(copy.components == graph.components);
+    CHECK(copy.toBinary() == data);
+}
+
+static void testEmptyGraph() {
+    auto copy = ComponentGraph::FromBinary(ComponentGraph{}.toBinary());
+    CHECK(copy.libraries.empty());
+    CHECK(copy.components.empty());
+}
+
+static void testCorruptedInput() {
+    auto data = makeGraph().toBinary();
+    // bad magic
+    auto bad_magic = data;
+    bad_magic[0] = 'X';
+    CHECK_THROWS(ComponentGraph::FromBinary(bad_magic));
+    // bad version
+    auto bad_version = data;
+    bad_version[8] = 42;
+    CHECK_THROWS(ComponentGraph::FromBinary(bad_version));
+    // truncation at every possible position
+    for(size_t size = 0; size < data.size(); ++size)
+        CHECK_THROWS(ComponentGraph::FromBinary(data.data(), size));
+    // trailing bytes
+    CHECK_THROWS(ComponentGraph::FromBinary(data + "x"));
+    // oversized library count (right after the magic and version)
+    auto oversized = data;
+    uint64_t huge = UINT64_MAX / 2;
+    std::memcpy(&oversized[12], &huge, sizeof(huge));
+    CHECK_THROWS(ComponentGraph::FromBinary(oversized));
+}
+
+static void testInvalidDependencies() {
+    ComponentGraph graph;
+    ComponentDescriptor c;
+    c.name = "c";
+    c.dependencies["d1"] = {{"p", "pool", DependencyKind::Pool, 0, false, ""}};
+    c.dependencies["d2"] = {};
+    graph.components.push_back(c);
+    auto data = graph.toBinary();
+    // rename "d2" into "d1"
+    auto pos = data.rfind("d2");
+    CHECK(pos != std::string::npos);
+    auto duplicate = data;
+    duplicate[pos + 1] = '1';
+    CHECK_THROWS(ComponentGraph::FromBinary(duplicate));
+    // invalid kind: the byte right after the type "pool" of the reference
+    pos = data.rfind("pool");
+    CHECK(pos != std::string::npos);
+    auto bad_kind = data;
+    bad_kind[pos + 4] = 42;
+    CHECK_THROWS(ComponentGraph::FromBinary(bad_kind));
+    // invalid is_self flag: after the kind and the provider id
+    auto bad_self = data;
+    bad_self[pos + 4 + 1 + sizeof(uint16_t)] = 2;
+    CHECK_THROWS(ComponentGraph::FromBinary(bad_self));
+}
+
+class DummyComponent : public AbstractComponent {
+    public:
+    void* getHandle() override { return nullptr; }
+};
+
+static void testFromArgs() {
+    ComponentArgs args;
+    args.name        = "comp";
+    args.provider_id = 5;
+    args.tags        = {"t"};
+    args.config      = "{}";
+    args.dependencies["pool"].push_back(
+        std::make_shared<NamedDependency>("my_pool", "pool", thallium::pool{}));
+    args.dependencies["other"].push_back(
+        std::make_shared<ProviderDependency>(
+            "other", "module_a", ComponentPtr{std::make_shared<DummyComponent>()}, 7));
+    auto desc = ComponentDescriptor::FromArgs("module_b", args);
+    CHECK(desc.name == "comp");
+    CHECK(desc.type == "module_b");
+    CHECK(desc.provider_id == 5);
+    CHECK(desc.dependencies["pool"].size() == 1);
+    CHECK(desc.dependencies["pool"][0].kind == DependencyKind::Pool);
+    CHECK(desc.dependencies["pool"][0].name == "my_pool");
+    CHECK(desc.dependencies["other"].size() == 1);
+    CHECK(desc.dependencies["other"][0].kind == DependencyKind::LocalProvider);
+    CHECK(desc.dependencies["other"][0].provider_id == 7);
+
+    auto with_null = args;
+    with_null.dependencies["other"].push_back(nullptr);
+    CHECK_THROWS(ComponentDescriptor::FromArgs("module_b", with_null));
+
+    args.dependencies["unknown"].push_back(
+        std::make_shared<NamedDependency>("unknown", "unknown", 42));
+    CHECK_THROWS(ComponentDescriptor::FromArgs("module_b", args));
+}
+
+static void testToArgs() {
+    auto component = ComponentPtr{std::make_shared<DummyComponent>()};
+    ComponentDescriptor desc;
+    desc.name        = "comp";
+    desc.type        = "module_b";
+    desc.provider_id = 5;
+    desc.tags        = {"t"};
+    desc.config      = "{}";
+    desc.dependencies["pool"] = {{"my_pool", "pool", DependencyKind::Pool, 0, false, ""}};
+    desc.dependencies["other"] = {{"other", "module_a", DependencyKind::LocalProvider, 7, false, ""}};
+
+    DependencyResolver resolver;
+    resolver.pool = [](const DependencyReference& ref) {
+        if(ref.name != "my_pool") throw Exception{"Unknown pool {}", ref.name};
+        return thallium::pool{};
+    };
+    resolver.local_provider = [&component](const DependencyReference& ref) {
+        return ref.name == "other" ? component : ComponentPtr{};
+    };
+    auto args = desc.toArgs(thallium::engine{}, resolver);
+    CHECK(args.name == "comp");
+    CHECK(args.provider_id == 5);
+    CHECK(args.tags == desc.tags);
+    CHECK(args.config == "{}");
+    CHECK(args.dependencies["pool"].size() == 1);
+    CHECK(args.dependencies["pool"][0]->hasHandleOfType<thallium::pool>());
+    CHECK(args.dependencies["other"].size() == 1);
+    CHECK(args.dependencies["other"][0]->getHandle<ComponentPtr>() == component);
+    auto provider = std::dynamic_pointer_cast<ProviderDependency>(args.dependencies["other"][0]);
+    CHECK(provider && provider->getProviderID() == 7);
+    // and back
+    CHECK(ComponentDescriptor::FromArgs("module_b", args) == desc);
+
+    // missing resolver function
+    CHECK_THROWS(desc.toArgs(thallium::engine{}, DependencyResolver{}));
+    // local provider not found
+    desc.dependencies["other"][0].name = "missing";
+    CHECK_THROWS(desc.toArgs(thallium::engine{}, resolver));
+}
+
+static void testSelfAddress() {
+    // "engine" plays the role of the process before restart,
+    // "restarted" the one after, with a different self address.
+    thallium::engine engine{"na+sm", THALLIUM_SERVER_MODE};
+    thallium::engine restarted{"na+sm", THALLIUM_SERVER_MODE};
+    {
+        auto engine_address    = static_cast<std::string>(engine.self());
+        auto restarted_address = static_cast<std::string>(restarted.self());
+        CHECK(engine_address != restarted_address);
+
+        ComponentArgs args;
+        args.name   = "comp";
+        args.engine = engine;
+        args.dependencies["handles"].push_back(
+            std::make_shared<ProviderDependency>(
+                "self", "module_a", thallium::provider_handle{engine.self(), 3}, 3));
+        args.dependencies["handles"].push_back(
+            std::make_shared<ProviderDependency>(
+                "remote", "module_a",
+                thallium::provider_handle{engine.lookup(restarted_address), 4}, 4));
+        auto desc = ComponentDescriptor::FromArgs("module_b", args);
+        auto& refs = desc.dependencies["handles"];
+        CHECK(refs.size() == 2);
+        CHECK(refs[0].kind == DependencyKind::ProviderHandle);
+        CHECK(refs[0].is_self);
+        CHECK(refs[0].address.empty());
+        CHECK(refs[0].provider_id == 3);
+        CHECK(!refs[1].is_self);
+        CHECK(refs[1].address == restarted_address);
+        CHECK(refs[1].provider_id == 4);
+
+        ComponentGraph graph;
+        graph.components.push_back(desc);
+        auto reloaded = ComponentGraph::FromBinary(graph.toBinary());
+        auto new_args = reloaded.components[0].toArgs(restarted, DependencyResolver{});
+        auto& deps = new_args.dependencies["handles"];
+        CHECK(deps.size() == 2);
+        auto self_ph = deps[0]->getHandle<thallium::provider_handle>();
+        CHECK(static_cast<std::string>(self_ph) == restarted_address);
+        CHECK(self_ph.provider_id() == 3);
+        auto remote_ph = deps[1]->getHandle<thallium::provider_handle>();
+        CHECK(static_cast<std::string>(remote_ph) == restarted_address);
+        CHECK(remote_ph.provider_id() == 4);
+
+        // a null provider handle is reported as a bedrock::Exception
+        args.dependencies["handles"].push_back(
+            std::make_shared<ProviderDependency>(
+                "null", "module_a", thallium::provider_handle{}, 0));
+        CHECK_THROWS(ComponentDescriptor::FromArgs("module_b", args));
+    }
+    restarted.finalize();
+    engine.finalize();
+}
+
+int main() {
+    testRoundTrip();
+    testEmptyGraph();
+    testCorruptedInput();
+    testInvalidDependencies();
+    testFromArgs();
+    testToArgs();
+    testSelfAddress();
+    if(s_failures) {
+        std::cerr << s_failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}